@@ -0,0 +1,161 @@
+#ifndef SENSINT_ACQUISITION_H
+#define SENSINT_ACQUISITION_H
+
+/**
+ * @brief This file provides an oversampled acquisition of the pressure sensor.
+ * A timer interrupt starts the ADC conversions at a high rate (with the ADC's
+ * hardware averaging) and the conversion complete interrupt collects the
+ * results in blocks. Neither interrupt waits for the ADC. Each block is
+ * decimated to the output rate with the filter in decimator.h. This replaces
+ * the exponential moving average of the single readings in loop().
+ *
+ * The sensing pin has to be connected to ADC0 (Teensy 3.x) or ADC1 (Teensy
+ * 4.x), which is the case for A0.
+ */
+
+#include <Arduino.h>
+
+#include "config.h"
+#include "decimator.h"
+
+namespace sensint {
+namespace acquisition {
+
+using Filter = filter::Decimator<config::kCicOrder, config::kDecimationFactor>;
+
+// each block yields one output sample
+static constexpr uint16_t kBlockSize = config::kDecimationFactor;
+static constexpr float kOutputRateHz =
+    static_cast<float>(config::kOversamplingRateHz) / config::kDecimationFactor;
+// both interrupts run below the default priority (128), so they don't delay
+// the servo pin interrupt
+static constexpr uint8_t kInterruptPriority = 192;
+
+namespace internal {
+IntervalTimer timer;
+Filter filter;
+uint32_t channel = 0;
+uint16_t blocks[2][kBlockSize];
+uint16_t write_position = 0;
+volatile uint8_t write_block = 0;
+volatile bool is_block_ready = false;
+volatile uint32_t overruns = 0;
+
+void StartConversionIsr() {
+  // writing the channel starts a conversion, the result raises an interrupt
+#if defined(KINETISK)
+  ADC0_SC1A = channel | ADC_SC1_AIEN;
+#elif defined(__IMXRT1062__)
+  ADC1_HC0 = channel | ADC_HC_AIEN;
+#endif
+}
+
+void ConversionCompleteIsr() {
+  // reading the result clears the interrupt flag
+#if defined(KINETISK)
+  blocks[write_block][write_position++] = ADC0_RA;
+#elif defined(__IMXRT1062__)
+  blocks[write_block][write_position++] = ADC1_R0;
+#endif
+  if (write_position == kBlockSize) {
+    write_position = 0;
+    if (is_block_ready) {
+      // the previous block was not processed in time and gets overwritten
+      overruns++;
+    }
+    write_block ^= 1;
+    is_block_ready = true;
+  }
+}
+}  // namespace internal
+
+/**
+ * @brief start sampling - the ADC resolution has to be set before
+ *
+ */
+static void Begin() {
+  using namespace internal;
+  analogReadAveraging(config::kHardwareAveraging);
+  // a single reading lets the core configure the ADC (clock, resolution,
+  // averaging, calibration) and select the channel of the pin
+  analogRead(config::kAnalogSensingPin);
+#if defined(KINETISK)
+  channel = ADC0_SC1A & ADC_SC1_ADCH(31);
+  attachInterruptVector(IRQ_ADC0, ConversionCompleteIsr);
+  NVIC_SET_PRIORITY(IRQ_ADC0, kInterruptPriority);
+  NVIC_ENABLE_IRQ(IRQ_ADC0);
+#elif defined(__IMXRT1062__)
+  channel = ADC1_HC0 & ADC_HC_ADCH(31);
+  attachInterruptVector(IRQ_ADC1, ConversionCompleteIsr);
+  NVIC_SET_PRIORITY(IRQ_ADC1, kInterruptPriority);
+  NVIC_ENABLE_IRQ(IRQ_ADC1);
+#endif
+  filter.Reset();
+  timer.priority(kInterruptPriority);
+  timer.begin(StartConversionIsr, 1000000.f / config::kOversamplingRateHz);
+}
+
+/**
+ * @brief decimate the last complete block - call this as often as possible
+ *
+ * @param value is set to the filtered sensor value if a new block was ready
+ * @return true if the value was updated
+ */
+static bool Update(float& value) {
+  if (!internal::is_block_ready) {
+    return false;
+  }
+  // the interrupt fills the other block meanwhile
+  noInterrupts();
+  const uint8_t read_block = internal::write_block ^ 1;
+  internal::is_block_ready = false;
+  interrupts();
+  float output;
+  if (internal::filter.Process(internal::blocks[read_block], kBlockSize,
+                               &output) == 0) {
+    return false;
+  }
+  value = output;
+  return true;
+}
+
+/**
+ * @brief number of blocks that were overwritten before Update() processed
+ * them
+ */
+static uint32_t Overruns() { return internal::overruns; }
+
+#ifdef SENSINT_ACQUISITION_BENCHMARK
+/**
+ * @brief measure the processing time of the decimator with synthetic data
+ * and blocks of the size that is used while sampling
+ *
+ * @return CPU cycles per input sample
+ */
+static float MeasureCyclesPerSample() {
+  static constexpr uint16_t kBlocks = 1024;
+  uint16_t input[kBlockSize];
+  float output;
+  for (uint16_t i = 0; i < kBlockSize; i++) {
+    input[i] = random(1U << 10);
+  }
+  Filter filter;
+  // keeps the compiler from dropping the unused results
+  volatile float sink = 0.f;
+  ARM_DEMCR |= ARM_DEMCR_TRCENA;
+  ARM_DWT_CTRL |= ARM_DWT_CTRL_CYCCNTENA;
+  uint32_t cycles = ARM_DWT_CYCCNT;
+  for (uint16_t i = 0; i < kBlocks; i++) {
+    filter.Process(input, kBlockSize, &output);
+    sink = output;
+  }
+  cycles = ARM_DWT_CYCCNT - cycles;
+  (void)sink;
+  return static_cast<float>(cycles) / (kBlocks * kBlockSize);
+}
+#endif  // SENSINT_ACQUISITION_BENCHMARK
+
+}  // namespace acquisition
+}  // namespace sensint
+
+#endif  // SENSINT_ACQUISITION_H
@@ -13,3 +13,29 @@
 #else
 #define SENSINT_BENCHMARK
 #endif  // SENSINT_BENCHMARK_MODE
+
+// The lean audio output replaces the audio graph of the Teensy Audio Library
+// to reduce the output latency. In the "platformio.ini" file you can specify
+// the audio mode and the block size.
+#if SENSINT_AUDIO_MODE == 1
+#define SENSINT_AUDIO_LEAN
+#else
+#undef SENSINT_AUDIO_LEAN
+#endif  // SENSINT_AUDIO_MODE
+
+// The oversampled acquisition replaces the exponential moving average of the
+// sensor readings in loop(). In the "platformio.ini" file you can specify the
+// acquisition mode.
+#if SENSINT_ACQUISITION_MODE == 1
+#define SENSINT_ACQUISITION_OVERSAMPLED
+#else
+#undef SENSINT_ACQUISITION_OVERSAMPLED
+#endif  // SENSINT_ACQUISITION_MODE
+
+// The processing time of the decimator can be printed at startup (development
+// build only). This is independent of the latency benchmark.
+#if SENSINT_ACQUISITION_BENCHMARK_MODE == 1
+#define SENSINT_ACQUISITION_BENCHMARK
+#else
+#undef SENSINT_ACQUISITION_BENCHMARK
+#endif  // SENSINT_ACQUISITION_BENCHMARK_MODE
@@ -31,6 +31,26 @@ static void InitializePins() {
   pinMode(kServoInputPin, INPUT_PULLDOWN);
 }
 
+//=========== oversampled acquisition ===========
+// only used if SENSINT_ACQUISITION_MODE is set to 1 (see platformio.ini)
+// sampling rate of the pressure sensor
+static constexpr uint32_t kOversamplingRateHz = 16000;
+// number of conversions the ADC averages in hardware per sample (0, 4, 8, 16
+// or 32)
+static constexpr uint8_t kHardwareAveraging = 4;
+// the CIC filter decimates the samples by this factor, hence the filtered
+// value is updated with kOversamplingRateHz / kDecimationFactor
+static constexpr uint16_t kDecimationFactor = 16;
+// number of CIC stages - more stages suppress the noise better but increase
+// the group delay of (kCicOrder * (kDecimationFactor - 1) / 2) samples
+static constexpr uint8_t kCicOrder = 3;
+
+//=========== scheduler ===========
+// allowed lateness of stopping a pulse, later stops count as deadline misses
+static constexpr uint32_t kStopPulseDeadlineUs = 50;
+// period of printing the scheduler statistics (debug builds only)
+static constexpr uint32_t kLogPeriodUs = 5000000;
+
 // serial communication
 static constexpr int kBaudRate = 115200;
 
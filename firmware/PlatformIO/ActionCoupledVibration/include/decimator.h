@@ -0,0 +1,161 @@
+#ifndef SENSINT_DECIMATOR_H
+#define SENSINT_DECIMATOR_H
+
+/**
+ * @brief This file provides a block based decimation filter for oversampled
+ * sensor readings: a CIC (cascaded integrator comb) decimator followed by a
+ * short FIR filter that compensates the passband droop of the CIC. It does not
+ * depend on the Teensy core, hence it can be compiled and checked on the host.
+ *
+ * The acquisition (timer + ADC) that feeds the decimator is implemented in the
+ * file acquisition.h.
+ */
+
+#include <stdint.h>
+
+namespace sensint {
+namespace filter {
+
+static constexpr uint32_t IntPow(const uint32_t base, const uint8_t exp) {
+  return (exp == 0) ? 1 : base * IntPow(base, exp - 1);
+}
+
+/**
+ * @brief CIC decimator with kOrder integrator and comb stages and a
+ * differential delay of one. The integrators use modular (wrap-around)
+ * arithmetic, hence overflows between the stages cancel out as long as the
+ * final result fits into 32 bits.
+ *
+ * @tparam kOrder number of stages (N)
+ * @tparam kFactor decimation factor (R)
+ */
+template <uint8_t kOrder, uint16_t kFactor>
+class CicDecimator {
+ public:
+  static_assert(kOrder >= 1 && kOrder <= 5, "CIC order must be in [1, 5]");
+  static_assert(kFactor >= 2, "decimation factor must be at least 2");
+  // 16-bit input samples and the DC gain R^N must fit into a signed 32-bit
+  // output
+  static_assert(IntPow(kFactor, kOrder) <= (1UL << 15),
+                "DC gain (factor ^ order) of the CIC exceeds 2^15");
+
+  // DC gain of the filter (R^N)
+  static constexpr uint32_t kGain = IntPow(kFactor, kOrder);
+  // group delay in input samples
+  static constexpr float kGroupDelay = kOrder * (kFactor - 1) / 2.f;
+
+  void Reset() {
+    for (uint8_t s = 0; s < kOrder; s++) {
+      integrators_[s] = 0;
+      combs_[s] = 0;
+    }
+  }
+
+  /**
+   * @brief decimate a block of samples
+   *
+   * @param input raw samples, the length has to be a multiple of kFactor -
+   * remaining samples are ignored
+   * @param length number of input samples
+   * @param output destination for length / kFactor samples (scaled by kGain)
+   * @return number of output samples
+   */
+  uint16_t Process(const uint16_t* __restrict input, const uint16_t length,
+                   int32_t* __restrict output) {
+    // keep the state in registers while processing the block
+    uint32_t integrators[kOrder];
+    for (uint8_t s = 0; s < kOrder; s++) {
+      integrators[s] = integrators_[s];
+    }
+    uint16_t count = 0;
+    for (uint16_t i = 0; i + kFactor <= length; i += kFactor) {
+      // fixed trip counts without branches, the compiler unrolls these loops
+      for (uint16_t j = 0; j < kFactor; j++) {
+        uint32_t value = input[i + j];
+        for (uint8_t s = 0; s < kOrder; s++) {
+          integrators[s] += value;
+          value = integrators[s];
+        }
+      }
+      uint32_t value = integrators[kOrder - 1];
+      for (uint8_t s = 0; s < kOrder; s++) {
+        const uint32_t delayed = combs_[s];
+        combs_[s] = value;
+        value -= delayed;
+      }
+      output[count++] = static_cast<int32_t>(value);
+    }
+    for (uint8_t s = 0; s < kOrder; s++) {
+      integrators_[s] = integrators[s];
+    }
+    return count;
+  }
+
+ private:
+  uint32_t integrators_[kOrder] = {};
+  uint32_t combs_[kOrder] = {};
+};
+
+/**
+ * @brief CIC decimator followed by a symmetric 3-tap FIR filter
+ * [-a, 1 + 2a, -a] that flattens the passband. The coefficient is chosen so
+ * that the second order terms of the CIC droop and of the FIR cancel out:
+ * a = N (1 - 1 / R^2) / 24. The output is normalized to the input range, so
+ * the result can be used like a raw (but less noisy) ADC reading.
+ *
+ * @tparam kOrder number of CIC stages (N)
+ * @tparam kFactor decimation factor (R)
+ */
+template <uint8_t kOrder, uint16_t kFactor>
+class Decimator {
+ public:
+  using Cic = CicDecimator<kOrder, kFactor>;
+
+  static constexpr float kCompensation =
+      kOrder * (1.f - 1.f / (static_cast<float>(kFactor) * kFactor)) / 24.f;
+  // group delay of CIC + FIR (one output sample) in input samples
+  static constexpr float kGroupDelay = Cic::kGroupDelay + kFactor;
+
+  void Reset() {
+    cic_.Reset();
+    history_[0] = 0.f;
+    history_[1] = 0.f;
+  }
+
+  /**
+   * @brief decimate a block of samples
+   *
+   * @param input raw samples, the length has to be a multiple of kFactor
+   * @param length number of input samples, at most kFactor * kMaxOutputs
+   * @param output destination for length / kFactor filtered samples
+   * @return number of output samples
+   */
+  uint16_t Process(const uint16_t* __restrict input, const uint16_t length,
+                   float* __restrict output) {
+    static constexpr float kScale = 1.f / Cic::kGain;
+    static constexpr float kCenter = 1.f + 2.f * kCompensation;
+    int32_t decimated[kMaxOutputs];
+    const uint16_t count = cic_.Process(
+        input, (length > kMaxInputs) ? kMaxInputs : length, decimated);
+    for (uint16_t i = 0; i < count; i++) {
+      const float value = decimated[i] * kScale;
+      output[i] = kCenter * history_[0] -
+                  kCompensation * (value + history_[1]);
+      history_[1] = history_[0];
+      history_[0] = value;
+    }
+    return count;
+  }
+
+  static constexpr uint16_t kMaxOutputs = 16;
+  static constexpr uint16_t kMaxInputs = kMaxOutputs * kFactor;
+
+ private:
+  Cic cic_;
+  float history_[2] = {};
+};
+
+}  // namespace filter
+}  // namespace sensint
+
+#endif  // SENSINT_DECIMATOR_H
@@ -0,0 +1,132 @@
+#ifndef SENSINT_LEAN_PT8211_H
+#define SENSINT_LEAN_PT8211_H
+
+/**
+ * @brief This file provides a lean output path for the PT8211 DAC. Instead of
+ * the audio graph of the Teensy Audio Library (128 samples per block and a
+ * pool of audio blocks) it uses its own I2S DMA double buffer with a block
+ * size that is set at compile time. Every time the DMA engine finished one
+ * half of the buffer, the renderer is called to fill it again. Hence, the
+ * output latency is bounded by the block size.
+ *
+ * The I2S clock and pin setup is shared with the Teensy Audio Library.
+ */
+
+#include <Arduino.h>
+#include <Audio.h>
+#include <DMAChannel.h>
+
+#include "pulse_renderer.h"
+
+#ifndef SENSINT_AUDIO_BLOCK_SIZE
+#define SENSINT_AUDIO_BLOCK_SIZE 16
+#endif  // SENSINT_AUDIO_BLOCK_SIZE
+
+namespace sensint {
+namespace audio {
+namespace lean_pt8211 {
+
+static constexpr uint16_t kBlockSize = SENSINT_AUDIO_BLOCK_SIZE;
+static_assert(kBlockSize >= 4 && kBlockSize <= AUDIO_BLOCK_SAMPLES,
+              "SENSINT_AUDIO_BLOCK_SIZE must be in [4, AUDIO_BLOCK_SAMPLES]");
+
+// with oversampling the library clocks the PT8211 at four times the sample
+// rate, so the renderer has to run at the same rate
+#ifdef AUDIO_PT8211_OVERSAMPLING
+static constexpr float kSampleRateHz = AUDIO_SAMPLE_RATE_EXACT * 4.f;
+#else
+static constexpr float kSampleRateHz = AUDIO_SAMPLE_RATE_EXACT;
+#endif  // AUDIO_PT8211_OVERSAMPLING
+
+/**
+ * @brief callback that fills a mono block with the next samples
+ */
+typedef void (*Renderer)(int16_t* block, uint16_t length);
+
+namespace internal {
+
+/**
+ * @brief exposes the I2S configuration of the audio library - this class is
+ * never instantiated
+ */
+class I2SConfig : public AudioOutputPT8211 {
+ public:
+  static void Configure() { config_i2s(); }
+};
+
+DMAChannel dma(false);
+DoubleBuffer<kBlockSize> buffer;
+int16_t mono_block[kBlockSize];
+Renderer renderer = nullptr;
+volatile uint32_t rendered_blocks = 0;
+
+void Isr() {
+  const auto read_address = reinterpret_cast<uintptr_t>(dma.TCD->SADDR);
+  dma.clearInterrupt();
+  int16_t* half = buffer.HalfToFill(read_address);
+  if (renderer != nullptr) {
+    renderer(mono_block, kBlockSize);
+  } else {
+    memset(mono_block, 0, sizeof(mono_block));
+  }
+  DoubleBuffer<kBlockSize>::Interleave(half, mono_block);
+#if defined(__IMXRT1062__)
+  arm_dcache_flush_delete(half, DoubleBuffer<kBlockSize>::kSizeInBytes / 2);
+#endif  // __IMXRT1062__
+  rendered_blocks++;
+}
+
+}  // namespace internal
+
+/**
+ * @brief set up I2S and DMA and start the output
+ *
+ * @param renderer callback that is called from the DMA interrupt
+ */
+static void Begin(const Renderer renderer) {
+  using namespace internal;
+  internal::renderer = renderer;
+  dma.begin(true);
+  buffer.Clear();
+  I2SConfig::Configure();
+  dma.TCD->SADDR = buffer.Data();
+  dma.TCD->SOFF = 2;
+  dma.TCD->ATTR = DMA_TCD_ATTR_SSIZE(1) | DMA_TCD_ATTR_DSIZE(1);
+  dma.TCD->NBYTES_MLNO = 2;
+  dma.TCD->SLAST =
+      -static_cast<int32_t>(DoubleBuffer<kBlockSize>::kSizeInBytes);
+  dma.TCD->DOFF = 0;
+  dma.TCD->CITER_ELINKNO = DoubleBuffer<kBlockSize>::kSizeInBytes / 2;
+  dma.TCD->DLASTSGA = 0;
+  dma.TCD->BITER_ELINKNO = DoubleBuffer<kBlockSize>::kSizeInBytes / 2;
+  dma.TCD->CSR = DMA_TCD_CSR_INTHALF | DMA_TCD_CSR_INTMAJOR;
+#if defined(KINETISK)
+  CORE_PIN22_CONFIG = PORT_PCR_MUX(6);  // pin 22, PTC1, I2S0_TXD0
+  dma.TCD->DADDR = &I2S0_TDR0;
+  dma.triggerAtHardwareEvent(DMAMUX_SOURCE_I2S0_TX);
+  dma.enable();
+  I2S0_TCSR = I2S_TCSR_SR;
+  I2S0_TCSR = I2S_TCSR_TE | I2S_TCSR_BCE | I2S_TCSR_FRDE;
+#elif defined(__IMXRT1062__)
+  CORE_PIN7_CONFIG = 3;  // 1:TX_DATA0
+  dma.TCD->DADDR = reinterpret_cast<void*>(
+      reinterpret_cast<uint32_t>(&I2S1_TDR0) + 2);
+  dma.triggerAtHardwareEvent(DMAMUX_SOURCE_SAI1_TX);
+  I2S1_RCSR |= I2S_RCSR_RE;
+  I2S1_TCSR |= I2S_TCSR_TE | I2S_TCSR_BCE | I2S_TCSR_FRDE;
+  dma.enable();
+#endif
+  dma.attachInterrupt(Isr);
+}
+
+/**
+ * @brief number of blocks rendered since Begin() - can be used to check that
+ * the DMA interrupt is running
+ */
+static uint32_t RenderedBlocks() { return internal::rendered_blocks; }
+
+}  // namespace lean_pt8211
+}  // namespace audio
+}  // namespace sensint
+
+#endif  // SENSINT_LEAN_PT8211_H
@@ -0,0 +1,226 @@
+#ifndef SENSINT_PULSE_RENDERER_H
+#define SENSINT_PULSE_RENDERER_H
+
+/**
+ * @brief This file provides the platform independent parts of the lean audio
+ * output path: a renderer that generates the pulse samples block by block and
+ * a double buffer that is shared with a DMA engine. Neither of them depends on
+ * the Teensy core, hence they can be compiled and checked on the host.
+ *
+ * The hardware specific part (I2S + DMA for the PT8211) is implemented in the
+ * file lean_pt8211.h.
+ */
+
+#include <math.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+namespace sensint {
+namespace audio {
+
+/**
+ * @brief Waveforms supported by the renderer. The values match the ones of
+ * the Teensy Audio Library (see settings::Waveform), so the settings can be
+ * passed without conversion. Unsupported waveforms are rendered as sine.
+ */
+static constexpr short kWaveformSine = 0;
+static constexpr short kWaveformSawtooth = 1;
+static constexpr short kWaveformSquare = 2;
+static constexpr short kWaveformTriangle = 3;
+static constexpr short kWaveformArbitrary = 4;
+static constexpr short kWaveformSawtoothReverse = 6;
+
+// number of entries in a wave table (one period), the table itself has one
+// additional entry to simplify the interpolation
+static constexpr uint16_t kWaveTableSize = 256;
+
+/**
+ * @brief generates the samples of a pulse with a phase accumulator. The
+ * parameters are set from the main loop and read from the DMA interrupt, so
+ * all of them are single 32-bit values that are written atomically.
+ */
+class PulseRenderer {
+ public:
+  explicit PulseRenderer(const float sample_rate_hz)
+      : sample_rate_hz_(sample_rate_hz) {
+    for (uint16_t i = 0; i <= kWaveTableSize; i++) {
+      sine_table_[i] = static_cast<int16_t>(
+          lroundf(32767.f * sinf(2.f * static_cast<float>(M_PI) * i /
+                                 static_cast<float>(kWaveTableSize))));
+    }
+  }
+
+  /**
+   * @brief select the waveform and restart the phase, so that a new pulse
+   * always starts at the beginning of a period
+   *
+   * @param waveform one of the kWaveform* values
+   */
+  void Begin(const short waveform) {
+    waveform_ = waveform;
+    reset_phase_ = true;
+  }
+
+  /**
+   * @brief set the frequency of the signal
+   *
+   * @param frequency_hz frequency in Hz, limited to [0, sample_rate / 2)
+   */
+  void SetFrequency(float frequency_hz) {
+    if (frequency_hz < 0.f) {
+      frequency_hz = 0.f;
+    } else if (frequency_hz > sample_rate_hz_ * 0.499f) {
+      frequency_hz = sample_rate_hz_ * 0.499f;
+    }
+    phase_increment_ =
+        static_cast<uint32_t>(frequency_hz * (4294967296.f / sample_rate_hz_));
+  }
+
+  /**
+   * @brief set the amplitude of the signal, zero mutes the output
+   *
+   * @param amplitude relative amplitude in the range [0, 1]
+   */
+  void SetAmplitude(float amplitude) {
+    if (amplitude < 0.f) {
+      amplitude = 0.f;
+    } else if (amplitude > 1.f) {
+      amplitude = 1.f;
+    }
+    magnitude_ = static_cast<int32_t>(amplitude * 65536.f);
+  }
+
+  /**
+   * @brief set the table that is used for kWaveformArbitrary
+   *
+   * @param data one period with (at least) kWaveTableSize samples
+   */
+  void SetArbitraryWaveform(const int16_t* data) { arbitrary_table_ = data; }
+
+  /**
+   * @brief render the next block of samples (mono)
+   *
+   * @param block destination of the samples
+   * @param length number of samples to render
+   */
+  void Render(int16_t* block, const uint16_t length) {
+    if (reset_phase_) {
+      phase_ = 0;
+      reset_phase_ = false;
+    }
+    const int32_t magnitude = magnitude_;
+    const uint32_t increment = phase_increment_;
+    if (magnitude == 0) {
+      memset(block, 0, length * sizeof(int16_t));
+      return;
+    }
+    const short waveform = waveform_;
+    uint32_t phase = phase_;
+    for (uint16_t i = 0; i < length; i++) {
+      const int32_t value = Sample(waveform, phase);
+      block[i] = static_cast<int16_t>((value * magnitude) >> 16);
+      phase += increment;
+    }
+    phase_ = phase;
+  }
+
+ private:
+  int32_t Sample(const short waveform, const uint32_t phase) const {
+    switch (waveform) {
+      case kWaveformSquare:
+        return (phase < 0x80000000U) ? 32767 : -32767;
+      case kWaveformSawtooth:
+        return static_cast<int32_t>(phase >> 16) - 32768;
+      case kWaveformSawtoothReverse:
+        return 32767 - static_cast<int32_t>(phase >> 16);
+      case kWaveformTriangle:
+        if (phase < 0x40000000U) {
+          return static_cast<int32_t>(phase >> 15);
+        } else if (phase < 0xC0000000U) {
+          return 32767 - static_cast<int32_t>((phase - 0x40000000U) >> 15);
+        }
+        return static_cast<int32_t>((phase - 0xC0000000U) >> 15) - 32768;
+      case kWaveformArbitrary:
+        if (arbitrary_table_ != nullptr) {
+          return Interpolate(arbitrary_table_, phase, true);
+        }
+        return Interpolate(sine_table_, phase, false);
+      default:
+        return Interpolate(sine_table_, phase, false);
+    }
+  }
+
+  // linear interpolation between two table entries with a 15-bit fraction
+  static int32_t Interpolate(const int16_t* table, const uint32_t phase,
+                             const bool wrap) {
+    const uint32_t index = phase >> 24;
+    const int32_t fraction = (phase >> 9) & 0x7FFF;
+    const int32_t v1 = table[index];
+    const int32_t v2 = table[wrap ? ((index + 1) & (kWaveTableSize - 1))
+                                  : index + 1];
+    return v1 + (((v2 - v1) * fraction) >> 15);
+  }
+
+  const float sample_rate_hz_;
+  int16_t sine_table_[kWaveTableSize + 1];
+  const int16_t* volatile arbitrary_table_ = nullptr;
+  volatile short waveform_ = kWaveformSine;
+  volatile uint32_t phase_increment_ = 0;
+  volatile int32_t magnitude_ = 0;
+  volatile bool reset_phase_ = false;
+  uint32_t phase_ = 0;
+};
+
+/**
+ * @brief stereo (interleaved) sample buffer that is split into two halves.
+ * While the DMA engine transmits one half, the other one is refilled.
+ *
+ * @tparam kBlockSize number of frames per half
+ */
+template <uint16_t kBlockSize>
+class DoubleBuffer {
+ public:
+  static constexpr uint16_t kChannels = 2;
+  static constexpr size_t kSamples = 2 * kBlockSize * kChannels;
+  static constexpr size_t kSizeInBytes = kSamples * sizeof(int16_t);
+
+  int16_t* Data() { return samples_; }
+
+  void Clear() { memset(samples_, 0, kSizeInBytes); }
+
+  /**
+   * @brief select the half that is safe to write
+   *
+   * @param read_address address the DMA engine will read next
+   * @return the half the DMA engine is not transmitting
+   */
+  int16_t* HalfToFill(const uintptr_t read_address) {
+    const auto first = reinterpret_cast<uintptr_t>(samples_);
+    if (read_address < first + kSizeInBytes / 2) {
+      return samples_ + kSamples / 2;
+    }
+    return samples_;
+  }
+
+  /**
+   * @brief copy a mono block into both channels of one half
+   *
+   * @param half destination returned by HalfToFill()
+   * @param mono kBlockSize samples
+   */
+  static void Interleave(int16_t* half, const int16_t* mono) {
+    for (uint16_t i = 0; i < kBlockSize; i++) {
+      *half++ = mono[i];
+      *half++ = mono[i];
+    }
+  }
+
+ private:
+  alignas(32) int16_t samples_[kSamples] = {};
+};
+
+}  // namespace audio
+}  // namespace sensint
+
+#endif  // SENSINT_PULSE_RENDERER_H
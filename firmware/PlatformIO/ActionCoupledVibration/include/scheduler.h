@@ -0,0 +1,217 @@
+#ifndef SENSINT_SCHEDULER_H
+#define SENSINT_SCHEDULER_H
+
+/**
+ * @brief This file provides a small cooperative scheduler for a fixed table of
+ * tasks that is declared at compile time. The table has to be sorted by
+ * priority, which can be checked with IsSortedByPriority() in a static_assert.
+ *
+ * Every pass of the scheduler (one call of RunOnce()) walks the table in the
+ * order of the priorities:
+ * - tasks that run on every pass (periodic tasks without a period) always run
+ * - of the due one-shot and periodic tasks, only the most urgent one runs
+ * - a background task only runs if no one-shot or periodic task was due
+ * Tasks are not preempted, hence a task waits at most for one pass: the tasks
+ * that run on every pass and the longest of the other tasks.
+ *
+ * The scheduler does not depend on the Teensy core - the clock is passed in,
+ * so it can be run with a simulated clock on the host.
+ */
+
+#include <stddef.h>
+#include <stdint.h>
+
+namespace sensint {
+namespace scheduler {
+
+typedef void (*TaskFunction)();
+// returns the current time in microseconds (wraps around)
+typedef uint32_t (*Clock)();
+
+/**
+ * @brief types of tasks
+ * kOneShot: runs once after each call of Release()
+ * kPeriodic: runs every period_us, or on every pass if the period is zero
+ * kBackground: like kPeriodic, but only if no other task is due
+ */
+enum class TaskType : uint8_t { kOneShot, kPeriodic, kBackground };
+
+/**
+ * @brief entry of a task table
+ * The deadline is the allowed lateness, i.e. the time between the release of
+ * a task and its start. A deadline of zero disables the check.
+ */
+typedef struct {
+  const char* name;
+  TaskFunction function;
+  TaskType type;
+  // 0 is the highest priority
+  uint8_t priority;
+  uint32_t period_us;
+  uint32_t deadline_us;
+} Task;
+
+/**
+ * @brief statistics collected for each task
+ */
+typedef struct {
+  uint32_t runs = 0;
+  uint32_t deadline_misses = 0;
+  uint32_t max_lateness_us = 0;
+  uint32_t max_duration_us = 0;
+} TaskStats;
+
+/**
+ * @brief check the order of a task table at compile time
+ *
+ * @param tasks the task table
+ * @return true if the priorities are in ascending order
+ */
+template <size_t kSize>
+constexpr bool IsSortedByPriority(const Task (&tasks)[kSize]) {
+  for (size_t i = 1; i < kSize; i++) {
+    if (tasks[i].priority < tasks[i - 1].priority) {
+      return false;
+    }
+  }
+  return true;
+}
+
+/**
+ * @brief runs the tasks of a fixed table
+ *
+ * @tparam kSize number of tasks in the table
+ */
+template <size_t kSize>
+class Scheduler {
+ public:
+  Scheduler(const Task (&tasks)[kSize], const Clock clock)
+      : tasks_(tasks), clock_(clock) {}
+
+  /**
+   * @brief release all periodic and background tasks and reset the
+   * statistics - this function should be called in setup()
+   *
+   */
+  void Begin() {
+    const uint32_t now = clock_();
+    for (size_t i = 0; i < kSize; i++) {
+      states_[i] = State();
+      states_[i].next_release_us = now;
+      states_[i].is_released = (tasks_[i].type != TaskType::kOneShot);
+    }
+  }
+
+  /**
+   * @brief run one pass - this function should be called in loop()
+   *
+   * @return true if a one-shot or periodic task with a period was due
+   */
+  bool RunOnce() {
+    bool is_task_due = false;
+    for (size_t i = 0; i < kSize; i++) {
+      if (tasks_[i].type == TaskType::kBackground) {
+        continue;
+      }
+      if (tasks_[i].type == TaskType::kPeriodic && tasks_[i].period_us == 0) {
+        Run(i, clock_());
+        continue;
+      }
+      if (!is_task_due) {
+        const uint32_t now = clock_();
+        if (IsDue(i, now)) {
+          is_task_due = true;
+          Run(i, now);
+        }
+      }
+    }
+    if (!is_task_due) {
+      for (size_t i = 0; i < kSize; i++) {
+        if (tasks_[i].type != TaskType::kBackground) {
+          continue;
+        }
+        const uint32_t now = clock_();
+        if (IsDue(i, now)) {
+          Run(i, now);
+          break;
+        }
+      }
+    }
+    return is_task_due;
+  }
+
+  /**
+   * @brief release a one-shot task
+   *
+   * @param index position of the task in the table
+   * @param time_us the task is due at this time; a pending release is replaced
+   */
+  void Release(const size_t index, const uint32_t time_us) {
+    states_[index].next_release_us = time_us;
+    states_[index].is_released = true;
+  }
+
+  const Task& GetTask(const size_t index) const { return tasks_[index]; }
+
+  const TaskStats& GetStats(const size_t index) const {
+    return states_[index].stats;
+  }
+
+  static constexpr size_t Size() { return kSize; }
+
+ private:
+  typedef struct {
+    uint32_t next_release_us = 0;
+    bool is_released = false;
+    TaskStats stats;
+  } State;
+
+  bool IsDue(const size_t index, const uint32_t now) const {
+    return states_[index].is_released &&
+           static_cast<int32_t>(now - states_[index].next_release_us) >= 0;
+  }
+
+  void Run(const size_t index, const uint32_t now) {
+    const Task& task = tasks_[index];
+    State& state = states_[index];
+    // tasks without a period have no release time to be late for
+    const uint32_t lateness =
+        (task.type == TaskType::kOneShot || task.period_us > 0)
+            ? now - state.next_release_us
+            : 0;
+    if (task.type == TaskType::kOneShot) {
+      // cleared before the call, so the task can release itself again
+      state.is_released = false;
+    }
+    task.function();
+    const uint32_t finished = clock_();
+    TaskStats& stats = state.stats;
+    if (lateness > stats.max_lateness_us) {
+      stats.max_lateness_us = lateness;
+    }
+    if (task.deadline_us > 0 && lateness > task.deadline_us) {
+      stats.deadline_misses++;
+    }
+    if (finished - now > stats.max_duration_us) {
+      stats.max_duration_us = finished - now;
+    }
+    stats.runs++;
+    if (task.type != TaskType::kOneShot) {
+      // keep the cadence, but skip releases that were missed entirely
+      // instead of running the task several times in a row
+      state.next_release_us += task.period_us;
+      if (static_cast<int32_t>(finished - state.next_release_us) >= 0) {
+        state.next_release_us = finished + task.period_us;
+      }
+    }
+  }
+
+  const Task (&tasks_)[kSize];
+  const Clock clock_;
+  State states_[kSize];
+};
+
+}  // namespace scheduler
+}  // namespace sensint
+
+#endif  // SENSINT_SCHEDULER_H
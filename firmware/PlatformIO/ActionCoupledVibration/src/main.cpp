@@ -7,7 +7,14 @@
 //=========== project headers ===========
 #include "build.h"
 #include "config.h"
+#include "scheduler.h"
 #include "settings.h"
+#ifdef SENSINT_AUDIO_LEAN
+#include "lean_pt8211.h"
+#endif  // SENSINT_AUDIO_LEAN
+#ifdef SENSINT_ACQUISITION_OVERSAMPLED
+#include "acquisition.h"
+#endif  // SENSINT_ACQUISITION_OVERSAMPLED
 #ifdef SENSINT_DEVELOPMENT
 // debug messages are only available in the development build
 #include "debug.h"
@@ -19,16 +26,20 @@
 namespace {
 
 //=========== audio variables ===========
+#ifdef SENSINT_AUDIO_LEAN
+sensint::audio::PulseRenderer signal(
+    sensint::audio::lean_pt8211::kSampleRateHz);
+#else
 AudioSynthWaveform signal;
 AudioOutputPT8211 to_haptuator;
 AudioConnection patchCord1(signal, 0, to_haptuator, 0);
 AudioConnection patchCord2(signal, 0, to_haptuator, 1);
+#endif  // SENSINT_AUDIO_LEAN
 
 //=========== sensor variables ===========
 float filtered_sensor_value = 0.f;
 
 //=========== control flow variables ===========
-elapsedMicros pulse_time_us = 0;
 bool is_vibrating = false;
 uint16_t last_bin_id = 0;
 uint16_t new_pulse_id = 0;
@@ -39,7 +50,6 @@ static constexpr int kMinServoPulseLength = 544;
 static constexpr int kMaxServoPulseLength = 2400;
 static constexpr int kMinServoAngle = 0;
 static constexpr int kMaxServoAngle = 180;
-elapsedMillis servo_timer_ms = 0;
 volatile uint32_t servo_pulse_length = 0;
 volatile bool is_new_servo_pulse = false;
 uint8_t servo_angle = 0;
@@ -55,11 +65,66 @@ inline void StopPulse() __attribute__((always_inline));
 inline void HandleServoPulse() __attribute__((always_inline));
 void ServoPinChangingEdge();
 
+//=========== tasks ===========
+void StopPulseTask();
+void SensingTask();
+void ServoTask();
+#ifdef SENSINT_DEBUG
+void LogTask();
+#endif  // SENSINT_DEBUG
+
+//=========== scheduler ===========
+// The table is sorted by priority (0 is the highest). Stopping the pulse and
+// sensing run before the housekeeping tasks. Sensing runs on every pass and
+// the pulse is stopped by a one-shot task that StartPulse() releases at the
+// end of the pulse. Background tasks only run if no other task is due.
+using sensint::scheduler::TaskType;
+static constexpr size_t kStopPulseTask = 0;
+constexpr sensint::scheduler::Task kTasks[] = {
+    {"stop pulse", StopPulseTask, TaskType::kOneShot, 0, 0,
+     sensint::config::kStopPulseDeadlineUs},
+    {"sensing", SensingTask, TaskType::kPeriodic, 1, 0, 0},
+    {"servo", ServoTask, TaskType::kPeriodic, 2,
+     sensint::settings::defaults::kServoDelayMs * 1000, 0},
+#ifdef SENSINT_DEBUG
+    {"log", LogTask, TaskType::kBackground, 3, sensint::config::kLogPeriodUs,
+     0},
+#endif  // SENSINT_DEBUG
+#ifdef SENSINT_DEVELOPMENT
+    // without a period the settings are polled whenever there is time left
+    {"settings", sensint::settings::UpdateSettingsFromSerialInput,
+     TaskType::kBackground, 4, 0, 0},
+#endif  // SENSINT_DEVELOPMENT
+};
+static_assert(sensint::scheduler::IsSortedByPriority(kTasks),
+              "the task table has to be sorted by priority");
+static_assert(kTasks[kStopPulseTask].function == StopPulseTask,
+              "kStopPulseTask has to point to the stop pulse task");
+sensint::scheduler::Scheduler<sizeof(kTasks) / sizeof(kTasks[0])>
+    task_scheduler(kTasks, micros);
+
 /**
  * @brief set up the audio system
  *
  */
 void SetupAudio() {
+#ifdef SENSINT_AUDIO_LEAN
+  // the renderer is called from the DMA interrupt whenever one half of the
+  // output buffer was transmitted
+  sensint::audio::lean_pt8211::Begin(
+      [](int16_t* block, uint16_t length) { signal.Render(block, length); });
+  delay(50);  // time for DAC voltage stable
+#ifdef SENSINT_ARB_WAVE
+  signal.SetArbitraryWaveform(sensint::benchmark::arb_wave_data);
+  signal.Begin(sensint::audio::kWaveformArbitrary);
+  signal.SetFrequency(40.f);
+  signal.SetAmplitude(0.f);
+#else
+  signal.Begin(sensint::settings::signal_generator_settings.waveform);
+  signal.SetFrequency(
+      sensint::settings::signal_generator_settings.frequency_hz);
+#endif  // SENSINT_ARB_WAVE
+#else
   AudioMemory(20);
   delay(50);  // time for DAC voltage stable
 #ifdef SENSINT_ARB_WAVE
@@ -71,6 +136,7 @@ void SetupAudio() {
   signal.begin(sensint::settings::signal_generator_settings.waveform);
   signal.frequency(sensint::settings::signal_generator_settings.frequency_hz);
 #endif  // SENSINT_ARB_WAVE
+#endif  // SENSINT_AUDIO_LEAN
 }
 
 /**
@@ -79,8 +145,15 @@ void SetupAudio() {
  *
  */
 void StartPulse() {
-  pulse_time_us = 0;
-#ifdef SENSINT_ARB_WAVE
+  task_scheduler.Release(
+      kStopPulseTask,
+      micros() + sensint::settings::signal_generator_settings.duration_us);
+#ifdef SENSINT_AUDIO_LEAN
+#ifndef SENSINT_ARB_WAVE
+  signal.Begin(sensint::settings::signal_generator_settings.waveform);
+#endif  // SENSINT_ARB_WAVE
+  signal.SetAmplitude(sensint::settings::signal_generator_settings.amp_pos);
+#elif defined(SENSINT_ARB_WAVE)
   // signal.begin(sensint::settings::signal_generator_settings.amp_pos, 40.f,
   //              static_cast<short>(sensint::settings::Waveform::kArbitrary));
   // signal.arbitraryWaveform(arb_wave_data, 40.f);
@@ -88,7 +161,7 @@ void StartPulse() {
 #else
   signal.amplitude(sensint::settings::signal_generator_settings.amp_pos);
   signal.begin(sensint::settings::signal_generator_settings.waveform);
-#endif  // SENSINT_ARB_WAVE
+#endif  // SENSINT_AUDIO_LEAN
   is_vibrating = true;
 #ifdef SENSINT_DEBUG
   sensint::debug::Log("start pulse");
@@ -100,7 +173,11 @@ void StartPulse() {
  *
  */
 void StopPulse() {
+#ifdef SENSINT_AUDIO_LEAN
+  signal.SetAmplitude(0.f);
+#else
   signal.amplitude(0.f);
+#endif  // SENSINT_AUDIO_LEAN
   is_vibrating = false;
 #ifdef SENSINT_DEBUG
   sensint::debug::Log("stop pulse");
@@ -134,57 +211,40 @@ void HandleServoPulse() {
   }
 }
 
-}  // namespace
-
-void setup() {
+/**
+ * @brief stop the pulse - the task is released by StartPulse() at the end of
+ * the pulse
+ *
+ */
+void StopPulseTask() {
   using namespace sensint;
 
-#if defined(SENSINT_DEVELOPMENT) || defined(SENSINT_BENCHMARK)
-  while (!Serial && millis() < 5000)
-    ;
-  Serial.begin(config::kBaudRate);
-  Serial.printf("\n\n================================================\n");
-  Serial.printf("Firmware: %s\n", FW_NAME);
-  Serial.printf(">>> version: %s\n", GIT_TAG);
-  Serial.printf(">>> revision: %s\n", GIT_REV);
-#ifdef SENSINT_DEBUG
-  Serial.println(">>> debugging enabled");
-#endif  // SENSINT_DEBUG
-#ifdef SENSINT_BENCHMARK
-  Serial.println(">>> benchmarking enabled");
-#endif  // SENSINT_BENCHMARK
-  Serial.printf("================================================\n");
-#endif  // SENSINT_DEVELOPMENT || SENSINT_BENCHMARK
-
-  config::InitializePins();
-  analogReadRes(settings::sensor_settings.resolution);
-  SetupAudio();
-
-  attachInterrupt(config::kServoInputPin, ServoPinChangingEdge, CHANGE);
-
+  if (is_vibrating) {
+    StopPulse();
 #ifdef SENSINT_BENCHMARK
-  benchmark::Initialize();
+    benchmark::Finish();
 #endif  // SENSINT_BENCHMARK
+  }
 }
 
-void loop() {
+/**
+ * @brief read the sensor, map it to a bin and start a pulse if the bin changed
+ *
+ */
+void SensingTask() {
   using namespace sensint;
 
-#ifdef SENSINT_DEVELOPMENT
-  settings::UpdateSettingsFromSerialInput();
-#endif  // SENSINT_DEVELOPMENT
-
-  if (is_new_servo_pulse &&
-      servo_timer_ms > settings::defaults::kServoDelayMs) {
-    HandleServoPulse();
-    servo_timer_ms = 0;
-  }
-
+#ifdef SENSINT_ACQUISITION_OVERSAMPLED
+  // the sensor is sampled in the background, a new filtered value is
+  // available with every decimated block
+  acquisition::Update(filtered_sensor_value);
+#else
   // read the sensor value and filter it
   auto sensor_value = analogRead(config::kAnalogSensingPin);
   filtered_sensor_value =
       (1.f - settings::sensor_settings.filter_weight) * filtered_sensor_value +
       settings::sensor_settings.filter_weight * sensor_value;
+#endif  // SENSINT_ACQUISITION_OVERSAMPLED
 
   // calculate the bin id depending on the filtered sensor value
   // (currently linear mapping)
@@ -231,13 +291,89 @@ void loop() {
 
     last_bin_id = mapped_bin_id;
   }
+}
 
-  if (is_vibrating) {
-    if (pulse_time_us >= settings::signal_generator_settings.duration_us) {
-      StopPulse();
+/**
+ * @brief update the settings if a new servo pulse was measured
+ *
+ */
+void ServoTask() {
+  if (is_new_servo_pulse) {
+    HandleServoPulse();
+  }
+}
+
+#ifdef SENSINT_DEBUG
+/**
+ * @brief print the statistics of the scheduler
+ *
+ */
+void LogTask() {
+  using namespace sensint;
+  for (size_t i = 0; i < task_scheduler.Size(); i++) {
+    const auto& stats = task_scheduler.GetStats(i);
+    debug::Log(String(task_scheduler.GetTask(i).name) + ": runs " +
+                   stats.runs + ", deadline misses " + stats.deadline_misses +
+                   ", max lateness us " + stats.max_lateness_us +
+                   ", max duration us " + stats.max_duration_us,
+               debug::DebugLevel::verbose);
+  }
+}
+#endif  // SENSINT_DEBUG
+
+}  // namespace
+
+void setup() {
+  using namespace sensint;
+
+#if defined(SENSINT_DEVELOPMENT) || defined(SENSINT_BENCHMARK)
+  while (!Serial && millis() < 5000)
+    ;
+  Serial.begin(config::kBaudRate);
+  Serial.printf("\n\n================================================\n");
+  Serial.printf("Firmware: %s\n", FW_NAME);
+  Serial.printf(">>> version: %s\n", GIT_TAG);
+  Serial.printf(">>> revision: %s\n", GIT_REV);
+#ifdef SENSINT_DEBUG
+  Serial.println(">>> debugging enabled");
+#endif  // SENSINT_DEBUG
 #ifdef SENSINT_BENCHMARK
-      benchmark::Finish();
+  Serial.println(">>> benchmarking enabled");
 #endif  // SENSINT_BENCHMARK
-    }
-  }
+#ifdef SENSINT_AUDIO_LEAN
+  Serial.printf(">>> audio output: lean PT8211 (%u samples per block)\n",
+                (unsigned)audio::lean_pt8211::kBlockSize);
+#else
+  Serial.printf(">>> audio output: audio library (%u samples per block)\n",
+                (unsigned)AUDIO_BLOCK_SAMPLES);
+#endif  // SENSINT_AUDIO_LEAN
+#ifdef SENSINT_ACQUISITION_OVERSAMPLED
+  Serial.printf(">>> acquisition: %u Hz decimated to %.1f Hz\n",
+                (unsigned)config::kOversamplingRateHz,
+                acquisition::kOutputRateHz);
+#ifdef SENSINT_ACQUISITION_BENCHMARK
+  Serial.printf(">>> decimator: %.2f cycles per input sample\n",
+                acquisition::MeasureCyclesPerSample());
+#endif  // SENSINT_ACQUISITION_BENCHMARK
+#endif  // SENSINT_ACQUISITION_OVERSAMPLED
+  Serial.printf("================================================\n");
+#endif  // SENSINT_DEVELOPMENT || SENSINT_BENCHMARK
+
+  config::InitializePins();
+  analogReadRes(settings::sensor_settings.resolution);
+#ifdef SENSINT_ACQUISITION_OVERSAMPLED
+  acquisition::Begin();
+#endif  // SENSINT_ACQUISITION_OVERSAMPLED
+  SetupAudio();
+
+  attachInterrupt(config::kServoInputPin, ServoPinChangingEdge, CHANGE);
+
+#ifdef SENSINT_BENCHMARK
+  benchmark::Initialize();
+#endif  // SENSINT_BENCHMARK
+
+  task_scheduler.Begin();
 }
+
+void loop() { task_scheduler.RunOnce(); }
+
@@ -0,0 +1,189 @@
+#include <math.h>
+#include <unity.h>
+
+#include "decimator.h"
+
+using namespace sensint::filter;
+
+namespace {
+
+static constexpr uint8_t kOrder = 3;
+static constexpr uint16_t kFactor = 16;
+static constexpr float kOffset = 32768.f;
+static constexpr float kAmplitude = 20000.f;
+// outputs that are skipped until the filters settled
+static constexpr uint16_t kSettleOutputs = 16;
+// outputs that are analyzed, a power of two to allow frequencies with an
+// integer number of periods
+static constexpr uint16_t kOutputs = 1024;
+
+uint16_t Sample(const double frequency, const uint32_t index) {
+  return static_cast<uint16_t>(
+      lround(kOffset + kAmplitude * sin(2. * M_PI * frequency * index)));
+}
+
+/**
+ * @brief amplitude of a sinusoid in the output, found by correlation over an
+ * integer number of periods
+ *
+ * @param output decimated samples without offset
+ * @param frequency frequency of the sinusoid in cycles per output sample
+ */
+double Amplitude(const double* output, const double frequency) {
+  double re = 0.;
+  double im = 0.;
+  for (uint16_t i = 0; i < kOutputs; i++) {
+    re += output[i] * cos(2. * M_PI * frequency * i);
+    im += output[i] * sin(2. * M_PI * frequency * i);
+  }
+  return 2. * sqrt(re * re + im * im) / kOutputs;
+}
+
+/**
+ * @brief amplitude of the filter output relative to the input
+ *
+ * @param frequency input frequency in cycles per output sample
+ * @param aliased frequency of the output in cycles per output sample
+ */
+double DecimatorGain(const double frequency, const double aliased) {
+  Decimator<kOrder, kFactor> decimator;
+  static uint16_t input[kFactor];
+  static double output[kOutputs];
+  uint32_t index = 0;
+  for (uint16_t i = 0; i < kSettleOutputs + kOutputs; i++) {
+    for (uint16_t j = 0; j < kFactor; j++, index++) {
+      input[j] = Sample(frequency / kFactor, index);
+    }
+    float value;
+    TEST_ASSERT_EQUAL(1, decimator.Process(input, kFactor, &value));
+    if (i >= kSettleOutputs) {
+      output[i - kSettleOutputs] = value - kOffset;
+    }
+  }
+  return Amplitude(output, aliased) / kAmplitude;
+}
+
+/**
+ * @brief amplitude of the CIC output relative to the input
+ *
+ * @param frequency input frequency in cycles per output sample
+ */
+double CicGain(const double frequency) {
+  CicDecimator<kOrder, kFactor> cic;
+  static uint16_t input[kFactor * 4];
+  static double output[kOutputs];
+  int32_t values[4];
+  uint32_t index = 0;
+  uint16_t count = 0;
+  while (count < kSettleOutputs + kOutputs) {
+    for (uint16_t j = 0; j < kFactor * 4; j++, index++) {
+      input[j] = Sample(frequency / kFactor, index);
+    }
+    TEST_ASSERT_EQUAL(4, cic.Process(input, kFactor * 4, values));
+    for (uint16_t i = 0; i < 4; i++, count++) {
+      if (count >= kSettleOutputs) {
+        output[count - kSettleOutputs] =
+            static_cast<double>(values[i]) / cic.kGain - kOffset;
+      }
+    }
+  }
+  return Amplitude(output, frequency) / kAmplitude;
+}
+
+/**
+ * @brief theoretical response of a CIC decimator
+ *
+ * @param frequency frequency in cycles per input sample
+ */
+double CicResponse(const double frequency) {
+  return pow(sin(M_PI * kFactor * frequency) /
+                 (kFactor * sin(M_PI * frequency)),
+             kOrder);
+}
+
+}  // namespace
+
+void setUp() {}
+
+void tearDown() {}
+
+void test_dc_gain_is_one() {
+  Decimator<kOrder, kFactor> decimator;
+  uint16_t input[kFactor];
+  for (uint16_t j = 0; j < kFactor; j++) {
+    input[j] = 1000;
+  }
+  float value = 0.f;
+  for (uint16_t i = 0; i < kSettleOutputs; i++) {
+    decimator.Process(input, kFactor, &value);
+  }
+  TEST_ASSERT_FLOAT_WITHIN(1e-3f, 1000.f, value);
+}
+
+void test_full_scale_input() {
+  // the static_assert allows a DC gain up to 2^15 for 16-bit input samples
+  CicDecimator<3, 32> cic;
+  uint16_t input[32];
+  for (uint16_t j = 0; j < 32; j++) {
+    input[j] = 65535;
+  }
+  int32_t value = 0;
+  for (uint16_t i = 0; i < kSettleOutputs; i++) {
+    cic.Process(input, 32, &value);
+  }
+  TEST_ASSERT_EQUAL_INT32(static_cast<int32_t>(65535UL * 32768UL), value);
+
+  Decimator<kOrder, kFactor> decimator;
+  float output = 0.f;
+  for (uint16_t i = 0; i < kSettleOutputs; i++) {
+    decimator.Process(input, kFactor, &output);
+  }
+  TEST_ASSERT_FLOAT_WITHIN(1e-2f, 65535.f, output);
+}
+
+void test_cic_matches_theoretical_response() {
+  // integer number of periods within kOutputs
+  const double frequencies[] = {51. / kOutputs, 102. / kOutputs,
+                                205. / kOutputs, 307. / kOutputs,
+                                409. / kOutputs};
+  for (const auto frequency : frequencies) {
+    TEST_ASSERT_FLOAT_WITHIN(1e-3, CicResponse(frequency / kFactor),
+                             CicGain(frequency));
+  }
+}
+
+void test_passband_is_flat_after_compensation() {
+  // the uncompensated CIC drops to 0.95 at 0.1 and 0.82 at 0.2 of the output
+  // rate
+  TEST_ASSERT_FLOAT_WITHIN(3e-3, 1., DecimatorGain(51. / kOutputs,
+                                                   51. / kOutputs));
+  TEST_ASSERT_FLOAT_WITHIN(3e-3, 1., DecimatorGain(102. / kOutputs,
+                                                   102. / kOutputs));
+  TEST_ASSERT_FLOAT_WITHIN(5e-2, 1., DecimatorGain(205. / kOutputs,
+                                                   205. / kOutputs));
+}
+
+void test_attenuation_above_output_nyquist() {
+  // input frequencies above half the output rate alias into the passband,
+  // the CIC attenuates them by at least 26 dB from 0.75 of the output rate on
+  // (the transition band between 0.5 and 0.75 is only attenuated weakly)
+  const double frequencies[] = {0.75, 0.9, 1.1, 1.3, 1.5, 2.4, 4.6, 7.5};
+  for (const auto frequency : frequencies) {
+    const double aliased = fabs(frequency - round(frequency));
+    const double periods = round(aliased * kOutputs);
+    const double input = round(frequency) +
+                         ((frequency < round(frequency)) ? -1. : 1.) *
+                             periods / kOutputs;
+    TEST_ASSERT_LESS_OR_EQUAL(0.05, DecimatorGain(input, periods / kOutputs));
+  }
+}
+
+int main(int argc, char** argv) {
+  UNITY_BEGIN();
+  RUN_TEST(test_dc_gain_is_one);
+  RUN_TEST(test_full_scale_input);
+  RUN_TEST(test_cic_matches_theoretical_response);
+  RUN_TEST(test_passband_is_flat_after_compensation);
+  RUN_TEST(test_attenuation_above_output_nyquist);
+  return UNITY_END();
+}
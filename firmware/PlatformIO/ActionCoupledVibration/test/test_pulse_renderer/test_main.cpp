@@ -0,0 +1,157 @@
+#include <unity.h>
+
+#include "pulse_renderer.h"
+
+using namespace sensint::audio;
+
+namespace {
+
+static constexpr float kSampleRateHz = 44100.f;
+static constexpr uint16_t kBlockSize = 16;
+
+int16_t Min(const int16_t* samples, const size_t length) {
+  int16_t value = samples[0];
+  for (size_t i = 1; i < length; i++) {
+    value = (samples[i] < value) ? samples[i] : value;
+  }
+  return value;
+}
+
+int16_t Max(const int16_t* samples, const size_t length) {
+  int16_t value = samples[0];
+  for (size_t i = 1; i < length; i++) {
+    value = (samples[i] > value) ? samples[i] : value;
+  }
+  return value;
+}
+
+}  // namespace
+
+void setUp() {}
+
+void tearDown() {}
+
+//=========== double buffer ===========
+void test_half_to_fill_while_dma_reads_first_half() {
+  DoubleBuffer<kBlockSize> buffer;
+  const auto first = reinterpret_cast<uintptr_t>(buffer.Data());
+  int16_t* second_half = buffer.Data() + DoubleBuffer<kBlockSize>::kSamples / 2;
+  TEST_ASSERT_EQUAL_PTR(second_half, buffer.HalfToFill(first));
+  TEST_ASSERT_EQUAL_PTR(
+      second_half,
+      buffer.HalfToFill(first + DoubleBuffer<kBlockSize>::kSizeInBytes / 2 -
+                        sizeof(int16_t)));
+}
+
+void test_half_to_fill_while_dma_reads_second_half() {
+  DoubleBuffer<kBlockSize> buffer;
+  const auto first = reinterpret_cast<uintptr_t>(buffer.Data());
+  TEST_ASSERT_EQUAL_PTR(
+      buffer.Data(),
+      buffer.HalfToFill(first + DoubleBuffer<kBlockSize>::kSizeInBytes / 2));
+  TEST_ASSERT_EQUAL_PTR(
+      buffer.Data(),
+      buffer.HalfToFill(first + DoubleBuffer<kBlockSize>::kSizeInBytes -
+                        sizeof(int16_t)));
+}
+
+void test_interleave_copies_mono_to_both_channels() {
+  int16_t mono[kBlockSize];
+  int16_t half[2 * kBlockSize];
+  for (uint16_t i = 0; i < kBlockSize; i++) {
+    mono[i] = static_cast<int16_t>(i * 1000 - 8000);
+  }
+  DoubleBuffer<kBlockSize>::Interleave(half, mono);
+  for (uint16_t i = 0; i < kBlockSize; i++) {
+    TEST_ASSERT_EQUAL_INT16(mono[i], half[2 * i]);
+    TEST_ASSERT_EQUAL_INT16(mono[i], half[2 * i + 1]);
+  }
+}
+
+//=========== pulse renderer ===========
+void test_zero_amplitude_renders_silence() {
+  PulseRenderer renderer(kSampleRateHz);
+  renderer.Begin(kWaveformSquare);
+  renderer.SetFrequency(100.f);
+  renderer.SetAmplitude(0.f);
+  int16_t block[kBlockSize];
+  for (uint16_t i = 0; i < kBlockSize; i++) {
+    block[i] = 12345;
+  }
+  renderer.Render(block, kBlockSize);
+  for (uint16_t i = 0; i < kBlockSize; i++) {
+    TEST_ASSERT_EQUAL_INT16(0, block[i]);
+  }
+}
+
+void test_begin_resets_phase() {
+  PulseRenderer renderer(kSampleRateHz);
+  renderer.Begin(kWaveformSine);
+  renderer.SetFrequency(250.f);
+  renderer.SetAmplitude(1.f);
+  int16_t first[kBlockSize];
+  int16_t block[kBlockSize];
+  renderer.Render(first, kBlockSize);
+  renderer.Render(block, kBlockSize);
+  renderer.Begin(kWaveformSine);
+  renderer.Render(block, kBlockSize);
+  TEST_ASSERT_EQUAL_INT16(0, block[0]);
+  for (uint16_t i = 0; i < kBlockSize; i++) {
+    TEST_ASSERT_EQUAL_INT16(first[i], block[i]);
+  }
+}
+
+void test_waveform_ranges() {
+  static constexpr size_t kLength = 441;  // one period of 100 Hz
+  const short waveforms[] = {kWaveformSine, kWaveformSawtooth,
+                             kWaveformSquare, kWaveformTriangle,
+                             kWaveformSawtoothReverse};
+  int16_t block[kLength];
+  for (const auto waveform : waveforms) {
+    PulseRenderer renderer(kSampleRateHz);
+    renderer.Begin(waveform);
+    renderer.SetFrequency(100.f);
+    renderer.SetAmplitude(1.f);
+    renderer.Render(block, kLength);
+    TEST_ASSERT_LESS_OR_EQUAL(-32000, Min(block, kLength));
+    TEST_ASSERT_GREATER_OR_EQUAL(32000, Max(block, kLength));
+
+    renderer.Begin(waveform);
+    renderer.SetAmplitude(0.5f);
+    renderer.Render(block, kLength);
+    TEST_ASSERT_GREATER_OR_EQUAL(-16384, Min(block, kLength));
+    TEST_ASSERT_LESS_OR_EQUAL(16384, Max(block, kLength));
+    TEST_ASSERT_LESS_OR_EQUAL(-16000, Min(block, kLength));
+    TEST_ASSERT_GREATER_OR_EQUAL(16000, Max(block, kLength));
+  }
+}
+
+void test_frequency() {
+  // count the rising zero crossings of one second of a sine
+  static constexpr size_t kLength = static_cast<size_t>(kSampleRateHz);
+  static int16_t block[kLength];
+  PulseRenderer renderer(kSampleRateHz);
+  renderer.Begin(kWaveformSine);
+  renderer.SetFrequency(100.f);
+  renderer.SetAmplitude(1.f);
+  renderer.Render(block, kLength);
+  int crossings = 0;
+  for (size_t i = 1; i < kLength; i++) {
+    if (block[i - 1] < 0 && block[i] >= 0) {
+      crossings++;
+    }
+  }
+  TEST_ASSERT_TRUE(crossings >= 99 && crossings <= 100);
+}
+
+int main(int argc, char** argv) {
+  UNITY_BEGIN();
+  RUN_TEST(test_half_to_fill_while_dma_reads_first_half);
+  RUN_TEST(test_half_to_fill_while_dma_reads_second_half);
+  RUN_TEST(test_interleave_copies_mono_to_both_channels);
+  RUN_TEST(test_zero_amplitude_renders_silence);
+  RUN_TEST(test_begin_resets_phase);
+  RUN_TEST(test_waveform_ranges);
+  RUN_TEST(test_frequency);
+  return UNITY_END();
+}
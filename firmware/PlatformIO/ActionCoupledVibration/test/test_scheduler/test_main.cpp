@@ -0,0 +1,182 @@
+#include <unity.h>
+
+#include "scheduler.h"
+
+using namespace sensint::scheduler;
+
+namespace {
+
+//=========== simulated system ===========
+// The tasks mirror the ones of the firmware. They don't do any work, instead
+// they advance the simulated clock by their duration.
+uint32_t now_us = 0;
+uint32_t sensing_duration_us = 0;
+uint32_t servo_duration_us = 0;
+uint32_t log_duration_us = 0;
+uint32_t settings_duration_us = 0;
+
+static constexpr uint32_t kPulseDurationUs = 10000;
+static constexpr uint32_t kStopPulseDeadlineUs = 50;
+// the sensor triggers a new pulse after this time (0 disables the pulses)
+uint32_t pulse_interval_us = 0;
+uint32_t last_pulse_us = 0;
+
+bool is_vibrating = false;
+uint32_t pulse_stop_us = 0;
+uint32_t pulses = 0;
+uint32_t max_stop_lateness_us = 0;
+
+uint32_t SimulatedClock() { return now_us; }
+
+void StopPulseTask();
+void SensingTask();
+void ServoTask() { now_us += servo_duration_us; }
+void LogTask() { now_us += log_duration_us; }
+void SettingsTask() { now_us += settings_duration_us; }
+
+static constexpr size_t kStopPulseTask = 0;
+constexpr Task kTasks[] = {
+    {"stop pulse", StopPulseTask, TaskType::kOneShot, 0, 0,
+     kStopPulseDeadlineUs},
+    {"sensing", SensingTask, TaskType::kPeriodic, 1, 0, 0},
+    {"servo", ServoTask, TaskType::kPeriodic, 2, 20000, 0},
+    {"log", LogTask, TaskType::kBackground, 3, 1000000, 0},
+    {"settings", SettingsTask, TaskType::kBackground, 4, 0, 0},
+};
+static_assert(IsSortedByPriority(kTasks), "task table is not sorted");
+
+Scheduler<sizeof(kTasks) / sizeof(kTasks[0])> scheduler(kTasks,
+                                                        SimulatedClock);
+
+void StopPulseTask() {
+  if (is_vibrating) {
+    const uint32_t lateness = now_us - pulse_stop_us;
+    if (lateness > max_stop_lateness_us) {
+      max_stop_lateness_us = lateness;
+    }
+    is_vibrating = false;
+  }
+  now_us += 1;
+}
+
+void SensingTask() {
+  now_us += sensing_duration_us;
+  if (pulse_interval_us > 0 && now_us - last_pulse_us >= pulse_interval_us) {
+    last_pulse_us = now_us;
+    is_vibrating = true;
+    pulse_stop_us = now_us + kPulseDurationUs;
+    scheduler.Release(kStopPulseTask, pulse_stop_us);
+    pulses++;
+  }
+}
+
+/**
+ * @brief run the scheduler for the given time, idle passes advance the clock
+ * by one microsecond
+ */
+void Simulate(const uint32_t duration_us) {
+  const uint32_t start = now_us;
+  while (now_us - start < duration_us) {
+    const uint32_t before = now_us;
+    scheduler.RunOnce();
+    if (now_us == before) {
+      now_us += 1;
+    }
+  }
+}
+
+// worst-case lateness of a task: one pass with the tasks that run on every
+// pass and the longest other task, plus an idle tick of the clock
+uint32_t LatenessBound() {
+  uint32_t longest = servo_duration_us;
+  longest = (log_duration_us > longest) ? log_duration_us : longest;
+  longest = (settings_duration_us > longest) ? settings_duration_us : longest;
+  return sensing_duration_us + longest + 1;
+}
+
+}  // namespace
+
+void setUp() {
+  // start close to the wrap-around of the 32-bit clock
+  now_us = 0xFFFF0000U;
+  sensing_duration_us = 5;
+  servo_duration_us = 20;
+  log_duration_us = 30;
+  settings_duration_us = 10;
+  // a pulse every 15 ms, so each pulse ends before the next one starts
+  pulse_interval_us = 15000;
+  last_pulse_us = now_us;
+  is_vibrating = false;
+  pulses = 0;
+  max_stop_lateness_us = 0;
+  scheduler.Begin();
+}
+
+void tearDown() {}
+
+void test_table_is_sorted_by_priority() {
+  static constexpr Task kUnsorted[] = {
+      {"b", ServoTask, TaskType::kPeriodic, 1, 0, 0},
+      {"a", LogTask, TaskType::kPeriodic, 0, 0, 0},
+  };
+  static_assert(!IsSortedByPriority(kUnsorted), "unsorted table not detected");
+  TEST_ASSERT_TRUE(IsSortedByPriority(kTasks));
+}
+
+void test_one_shot_task_runs_once_per_release() {
+  pulse_interval_us = 0;
+  Simulate(1000);
+  TEST_ASSERT_EQUAL_UINT32(0, scheduler.GetStats(kStopPulseTask).runs);
+  scheduler.Release(kStopPulseTask, now_us + 100);
+  Simulate(99);
+  TEST_ASSERT_EQUAL_UINT32(0, scheduler.GetStats(kStopPulseTask).runs);
+  Simulate(1000);
+  TEST_ASSERT_EQUAL_UINT32(1, scheduler.GetStats(kStopPulseTask).runs);
+}
+
+void test_background_runs_only_in_leftover_time() {
+  // every pass of the sensing task takes longer than the servo period, so the
+  // servo task is always due and the background tasks never run
+  sensing_duration_us = 25000;
+  Simulate(1000000);
+  TEST_ASSERT_EQUAL_UINT32(0, scheduler.GetStats(3).runs);
+  TEST_ASSERT_EQUAL_UINT32(0, scheduler.GetStats(4).runs);
+  TEST_ASSERT_GREATER_THAN(0, scheduler.GetStats(2).runs);
+}
+
+void test_pulse_stop_meets_deadline_under_load() {
+  Simulate(10000000);
+  const auto& stats = scheduler.GetStats(kStopPulseTask);
+  TEST_ASSERT_GREATER_THAN(600, pulses);
+  TEST_ASSERT_GREATER_THAN(600, stats.runs);
+  TEST_ASSERT_LESS_OR_EQUAL_UINT32(LatenessBound(), stats.max_lateness_us);
+  TEST_ASSERT_EQUAL_UINT32(stats.max_lateness_us, max_stop_lateness_us);
+  TEST_ASSERT_LESS_OR_EQUAL_UINT32(kStopPulseDeadlineUs, LatenessBound());
+  TEST_ASSERT_EQUAL_UINT32(0, stats.deadline_misses);
+}
+
+void test_pulse_stop_lateness_is_bounded_by_slow_tasks() {
+  // slow housekeeping and background steps delay the pulse stop, but never
+  // by more than one pass
+  servo_duration_us = 400;
+  log_duration_us = 2000;
+  settings_duration_us = 300;
+  Simulate(10000000);
+  const auto& stats = scheduler.GetStats(kStopPulseTask);
+  TEST_ASSERT_GREATER_THAN(600, stats.runs);
+  TEST_ASSERT_LESS_OR_EQUAL_UINT32(LatenessBound(), stats.max_lateness_us);
+  TEST_ASSERT_LESS_OR_EQUAL_UINT32(LatenessBound(), max_stop_lateness_us);
+  TEST_ASSERT_GREATER_THAN(kStopPulseDeadlineUs, stats.max_lateness_us);
+  TEST_ASSERT_GREATER_THAN(0, stats.deadline_misses);
+  TEST_ASSERT_LESS_OR_EQUAL_UINT32(stats.runs, stats.deadline_misses);
+}
+
+int main(int argc, char** argv) {
+  UNITY_BEGIN();
+  RUN_TEST(test_table_is_sorted_by_priority);
+  RUN_TEST(test_one_shot_task_runs_once_per_release);
+  RUN_TEST(test_background_runs_only_in_leftover_time);
+  RUN_TEST(test_pulse_stop_meets_deadline_under_load);
+  RUN_TEST(test_pulse_stop_lateness_is_bounded_by_slow_tasks);
+  return UNITY_END();
+}
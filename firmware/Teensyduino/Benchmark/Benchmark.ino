@@ -27,6 +27,17 @@
  */
 #define USE_MICROS
 
+/* Set a label for the audio output path of the ServoHaptic controller
+ * (see SENSINT_AUDIO_MODE in the PlatformIO firmware), e.g.
+ *  - "audio library": AudioOutputPT8211 with 128 samples per block
+ *  - "lean 16": lean PT8211 output with 16 samples per block
+ * The label is printed with the results, so the logs of several
+ * runs can be compared. The label is not checked against the
+ * controller, hence it must match the line ">>> audio output: ..."
+ * that the ServoHaptic controller prints at startup.
+ */
+#define OUTPUT_PATH "audio library"
+
 namespace {
   /* This pin is connected to the ServoHaptic controller's sensor input.
    * Setting it HIGH will trigger the ServoHaptic controller to start a pulse.
@@ -64,6 +75,12 @@ namespace {
    */
   constexpr uint32_t kIterations = 1000;
   uint32_t iteration = 0;
+
+  /* Summary of all iterations (in microseconds or clock cycles).
+   */
+  uint32_t min_latency = UINT32_MAX;
+  uint32_t max_latency = 0;
+  uint64_t sum_latency = 0;
   
   // each iteration pauses for a given duration (blocking)
   constexpr uint32_t kTriggerDelayMinMs = 1;
@@ -82,6 +99,7 @@ void setup() {
   digitalWriteFast(kTriggerOutPin, LOW);
 
   Serial.println("Benchmark");
+  Serial.printf(" >>> output path: %s\n", OUTPUT_PATH);
 #ifdef USE_MICROS
   Serial.println(" >>> time measurement in microseconds");
 #else
@@ -125,11 +143,15 @@ void loop() {
     /* Write result of this iteration to the serial port.
      */
 #ifdef USE_MICROS
-    Serial.print(delta_time);
+    uint32_t latency = delta_time;
 #else
-    Serial.print(delta_cycles);
+    uint32_t latency = delta_cycles;
 #endif
+    Serial.print(latency);
     Serial.print(',');
+    min_latency = min(min_latency, latency);
+    max_latency = max(max_latency, latency);
+    sum_latency += latency;
 
     /* Wait for ServoHaptic controller to finish the pulse (i.e. go to LOW). 
      */
@@ -145,6 +167,9 @@ void loop() {
     /* After running all iterations the firmware will stop, i.e. enter an infinite loop.
      */
     Serial.printf("\n >>> Finished benchmark with %d iterations.\n", (int)kIterations);
+    Serial.printf(" >>> %s: min %u, mean %u, max %u\n", OUTPUT_PATH,
+                  (unsigned)min_latency, (unsigned)(sum_latency / kIterations),
+                  (unsigned)max_latency);
     while (true) ;
   }
 }